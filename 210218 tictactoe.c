@@ -27,23 +27,42 @@
 #define BBSY 70                   // back button size y-axis
 #define BDX (MAX_X - 3 * BBR) / 2 // height of button x-axis
 #define BDY (MAX_Y - 3 * BBR) / 2 // height of button y-axis
+#define FIELD_X(i) (XBR + 2 * (i) * SKP + (i) * DIM) // x-axis origin of field in row i
+#define FIELD_Y(j) (YBR + 2 * (j) * SKP + (j) * DIM) // y-axis origin of field in column j
 
 // Pinout
 #define LCD_DATA_H PORTB // data pins DB8-DB15
 #define LCD_DATA_L PORTA // data pins DB0-DB7
+#define LCD_DDR_H  DDRB  // direction of data pins DB8-DB15
+#define LCD_DDR_L  DDRA  // direction of data pins DB0-DB7
+#define LCD_PIN_H  PINB  // reading data pins DB8-DB15
+#define LCD_PIN_L  PINA  // reading data pins DB0-DB7
 
 #define LCD_RS    PC0 // changing between commands and data
 #define LCD_WR    PC1 // write data
-#define LCD_RD    PC2 // read data
 #define LCD_CS    PC6 // chip select
 #define LCD_RESET PC7 // lcd reset
 
+// PC2 is also used by JTAG (TCK), define LCD_RD_ALT to move read pin to PD5
+// and connect the RD wire of the screen to PD5 instead
+#ifdef LCD_RD_ALT
+#define LCD_RD_PORT PORTD
+#define LCD_RD      PD5 // read data
+#else
+#define LCD_RD_PORT PORTC
+#define LCD_RD      PC2 // read data
+#endif
+
 #define T_CLK PD0 // touch controller clock
 #define T_CS  PD1 // chip select
 #define T_DIN PD2 // sending commands or data to touch part of screen, x and y coordinates
 #define T_DO  PD3 // receiving data from touch part of screen
 #define T_IRQ PD4 // interrupt, 1 if the screen is being touched
 
+// Time RD is held low before reading data pins, SSD1289 read cycle needs
+// RD low for at least 500 ns (much slower than writing), 1 us leaves margin
+#define LCD_RD_DELAY_US 1
+
 // RS definitions
 #define CMD 0  // command
 #define DATA 1 // data
@@ -146,6 +165,53 @@ void TFT_write(uint16_t val, uint8_t rs) {
     PORTC |= _BV(LCD_CS);
 }
 
+// switching data pins to input so the screen can drive them
+void TFT_bus_input() {
+    LCD_DDR_H = 0x00;
+    LCD_DDR_L = 0x00;
+    LCD_DATA_H = 0x00; // no pull-ups
+    LCD_DATA_L = 0x00;
+}
+
+// switching data pins back to output for writing
+void TFT_bus_output() {
+    LCD_DDR_H = 0xff;
+    LCD_DDR_L = 0xff;
+}
+
+// reading data from screen, RS and WR have to be high, CS low and data pins switched to input
+uint16_t TFT_read() {
+    LCD_RD_PORT &= ~_BV(LCD_RD);
+    _delay_us(LCD_RD_DELAY_US); // waiting for screen to put data on pins
+    uint16_t val = ((uint16_t)LCD_PIN_H << 8) | LCD_PIN_L;
+    LCD_RD_PORT |= _BV(LCD_RD);
+    return val;
+}
+
+// preparing screen for reading data, has to be called after TFT_set_address
+void TFT_read_start() {
+    // WR is low when idle, it has to be high while reading so the screen
+    // never sees RD and WR low at the same time. Raising it while CS is high
+    // doesn't write anything.
+    PORTC |= _BV(LCD_WR);
+    PORTC |= _BV(LCD_RS);
+    PORTC &= ~_BV(LCD_CS);
+    TFT_bus_input();
+    TFT_read(); // first read after setting the address is a dummy read
+}
+
+// returning screen to writing after TFT_read_start
+void TFT_read_end() {
+    PORTC |= _BV(LCD_CS);
+    PORTC &= ~_BV(LCD_WR);
+    TFT_bus_output();
+}
+
+// swapping red and blue parts of a color
+uint16_t swap_rb(uint16_t color) {
+    return (color & 0x07E0) | (color >> 11) | (color << 11);
+}
+
 // sending specified command and value to memory
 void TFT_write_pair(uint16_t cmd, uint16_t data) {
     TFT_write(cmd, CMD);
@@ -162,6 +228,42 @@ void TFT_set_address(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
     TFT_write(0x0022, CMD);
 }
 
+// setting drawing area back to the whole screen
+void TFT_reset_address() {
+    TFT_set_address(0, 0, MAX_X - 1, MAX_Y - 1);
+}
+
+// Set by TFT_test_read
+static uint8_t gram_read_ok = 0;   // reading from screen memory works
+static uint8_t gram_read_swap = 0; // screen returns colors with red and blue swapped
+
+/**
+ * Writes a few colors to the first pixel and reads them back to check if
+ * reading from screen memory works (RD pin connected, timing good enough).
+ * Colors read back with red and blue swapped are accepted and fixed when saving.
+ */
+void TFT_test_read() {
+    static const uint16_t colors[4] = {0xF800, 0x07E0, 0x001F, 0x5AA5};
+    uint8_t same = 0, swapped = 0;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        TFT_set_address(0, 0, 0, 0);
+        TFT_write(colors[i], DATA);
+
+        TFT_set_address(0, 0, 0, 0);
+        TFT_read_start();
+        uint16_t val = TFT_read();
+        TFT_read_end();
+
+        same += val == colors[i];
+        swapped += val == swap_rb(colors[i]);
+    }
+    TFT_reset_address();
+
+    gram_read_ok = same == 4 || swapped == 4;
+    gram_read_swap = swapped == 4;
+}
+
 void TFT_init(void) {
     DDRA = 0xff ;
     DDRB = 0xff;
@@ -175,7 +277,7 @@ void TFT_init(void) {
     _delay_ms(10);
     PORTC |= _BV(LCD_RESET);
     PORTC |= _BV(LCD_CS);
-    PORTC |= _BV(LCD_RD);
+    LCD_RD_PORT |= _BV(LCD_RD);
     PORTC &= ~_BV(LCD_WR);
     _delay_ms(20);
 
@@ -218,6 +320,8 @@ void TFT_init(void) {
     TFT_write_pair(0x0023, 0x0000); _delay_ms(1);
     TFT_write_pair(0x0024, 0x0000); _delay_ms(1);
 
+    TFT_test_read();
+
     TFT_write_pair(0x004f, 0);
     TFT_write_pair(0x004e, 0);
     TFT_write(0x0022, CMD);
@@ -367,6 +471,93 @@ void draw_rectangle(uint16_t x, uint16_t y, uint16_t dx, uint16_t dy, uint16_t c
     draw_v_line(y + dy, x, x + dx, color);
 }
 
+// Saved screen regions, ATmega16 has only 1 KB of RAM so the buffer is sized
+// for nearly flat areas (backgrounds under overlays), not for text or marks
+#define REGION_RUNS 8 // max number of different color runs in a saved region
+
+typedef struct {
+    uint16_t x, y, dx, dy;
+    uint8_t runs;                 // 0 if the region couldn't be saved
+    uint16_t count[REGION_RUNS];  // number of pixels in each run
+    uint16_t color[REGION_RUNS];  // color of each run
+} region_t;
+
+static region_t result_region; // under the result box
+static region_t label_region;  // under the player label
+static region_t field_region;  // empty field of the grid
+
+/**
+ * Reads pixels of a region from screen memory and stores them as runs of the
+ * same color, so overlays can be removed without redrawing what is under them.
+ * Only nearly flat areas fit: a region can have at most REGION_RUNS runs, so
+ * anything with text, marks or box outlines in it can't be saved.
+ * Region must not be bigger than 65535 pixels.
+ * Returns 0 if reading doesn't work or the region has more colors than fit in the buffer.
+ */
+uint8_t save_region(region_t *r, uint16_t x, uint16_t y, uint16_t dx, uint16_t dy) {
+    uint16_t pixels = (dx + 1) * (dy + 1);
+    uint8_t ok = 1;
+
+    r->x = x;
+    r->y = y;
+    r->dx = dx;
+    r->dy = dy;
+    r->runs = 0;
+
+    if (!gram_read_ok) {
+        return 0;
+    }
+
+    TFT_set_address(x, MAX_Y - y - dy, x + dx, MAX_Y - y);
+    TFT_read_start();
+
+    for (uint16_t i = 0; i < pixels && ok; i++) {
+        uint16_t pixel = TFT_read();
+        if (gram_read_swap) {
+            pixel = swap_rb(pixel);
+        }
+        if (r->runs && r->color[r->runs - 1] == pixel) {
+            r->count[r->runs - 1]++;
+        } else if (r->runs < REGION_RUNS) {
+            r->color[r->runs] = pixel;
+            r->count[r->runs] = 1;
+            r->runs++;
+        } else {
+            ok = 0;
+        }
+    }
+
+    TFT_read_end();
+    TFT_reset_address();
+
+    if (!ok) {
+        r->runs = 0;
+    }
+    return ok;
+}
+
+// writes saved pixels to the specified position, returns 0 if nothing was saved
+uint8_t restore_region_at(const region_t *r, uint16_t x, uint16_t y) {
+    if (!r->runs) {
+        return 0;
+    }
+
+    TFT_set_address(x, MAX_Y - y - r->dy, x + r->dx, MAX_Y - y);
+    for (uint8_t i = 0; i < r->runs; i++) {
+        for (uint16_t j = 0; j < r->count[i]; j++) {
+            TFT_write(r->color[i], DATA);
+        }
+    }
+    TFT_reset_address();
+
+    return 1;
+}
+
+// writes saved pixels back to where they were read from
+uint8_t restore_region(const region_t *r) {
+    return restore_region_at(r, r->x, r->y);
+}
+
 void initialize_grid() {
     // Setting background color
     set_background_color(CYAN);
@@ -381,6 +572,31 @@ void initialize_grid() {
     // Drawing back button
     draw_rectangle(SKP, SKP, BBSX, BBSY, WHITE);
     print_string(SKP + 8, SKP + 5, 3, WHITE, CYAN, "BACK\0"); // Text width = 60, Text height = 24
+
+    // Saving empty areas that get covered during the game
+    save_region(&label_region, SKP + BBSX + 8, SKP + 5, 30, 32);
+    save_region(&field_region, XBR + SKP, YBR + SKP, DIM - 2 * SKP, DIM - 2 * SKP);
+}
+
+// removes result box, player label and marks, repaints the grid only if they weren't saved
+void clear_grid(uint8_t board[3][3]) {
+    if (!field_region.runs || !result_region.runs || !label_region.runs) {
+        initialize_grid();
+        return;
+    }
+
+    restore_region(&result_region);
+    restore_region(&label_region);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t x = FIELD_X(i);
+        for (uint8_t j = 0; j < 3; j++) {
+            uint16_t y = FIELD_Y(j);
+            if (board[i][j] != EMPTY) {
+                restore_region_at(&field_region, x + SKP, y + SKP);
+            }
+        }
+    }
 }
 
 void initialize_menu() {
@@ -494,8 +710,8 @@ uint8_t best_move(uint8_t board[3][3], uint8_t move_counter, uint8_t ai_player)
 uint8_t draw_on_grid(uint8_t board[3][3], uint8_t i, uint8_t j, uint8_t mark) {
         board[i][j] = mark;
 
-        uint8_t x = XBR + 2 * i * SKP + i * DIM;
-        uint16_t y = YBR + 2 * j * SKP + j * DIM;
+        uint8_t x = FIELD_X(i);
+        uint16_t y = FIELD_Y(j);
         if (mark == NOUGHT) {
             draw_circle(x + SKP, y + SKP, RAD - SKP, GREEN);
             return CROSS;
@@ -525,6 +741,8 @@ void main() {
         if (flagGameInProgress && !flagGameDone) {
             flagGameDone = game_over(board);
             if (move_counter >= 9 || flagGameDone) {
+                save_region(&result_region, MAX_X - SKP - BBSY - 32, SKP, BBSY + 32, BBSY);
+
                 if (!flagGameDone) {
                     print_string(MAX_X - SKP - BBSY - 32, SKP + 5, 3, WHITE, CYAN, "DRAW\0"); // Text width = 60, Text height = 24
                 } else {
@@ -566,7 +784,9 @@ void main() {
             }
 
             if (flagGameDone && move_counter >= 9) {
-                print_string(SKP + BBSX + 8, SKP + 5, 3, WHITE, CYAN, "  \0"); // Text width = 30, Text height = 24
+                if (!restore_region(&label_region)) {
+                    print_string(SKP + BBSX + 8, SKP + 5, 3, WHITE, CYAN, "  \0"); // Text width = 30, Text height = 24
+                }
             }
         }
 
@@ -616,7 +836,7 @@ void main() {
                 if (flagGameDone) {
                     if (check_touch(TP_X, TP_Y, MAX_X - SKP - BBSY, SKP, BBSY, BBSY)) {
                         // Reseting game
-                        initialize_grid();
+                        clear_grid(board);
                         move_counter = 0;
                         player = CROSS;
                         flagGameDone = 0;
@@ -632,9 +852,9 @@ void main() {
 
                 // Detecting touch on grid
                 for (uint8_t i = 0; i < 3; i++) {
-                    uint8_t x = XBR + 2 * i * SKP + i * DIM;
+                    uint8_t x = FIELD_X(i);
                     for (uint8_t j = 0; j < 3; j++) {
-                        uint16_t y = YBR + 2 * j * SKP + j * DIM;
+                        uint16_t y = FIELD_Y(j);
 
                         if (check_touch(TP_X, TP_Y, x, y, DIM, DIM)) {
                             if (board[i][j] == EMPTY) {